@@ -0,0 +1,97 @@
+#!/bin/bash
+
+### Batería de escenarios fijos para detectar regresiones de resultados y de rendimiento ###
+#
+# Uso:  ./ejecutaBenchmark.sh              Compara cada escenario con su referencia en benchmark/
+#       ./ejecutaBenchmark.sh --actualiza  Guarda los resultados actuales como nuevas referencias
+#
+# Sup. directorio de ns3 añadido a PATH (igual que ejecutaPrueba.sh). Si se define PRACTICA05 con la ruta de un
+# binario ya compilado, se usa ese en lugar de waf. Si se define INFORME, se añade a ese fichero una línea por
+# escenario con su tiempo real y eventos por segundo (lo usa ejecutaPGO.sh para comparar compilaciones).
+#
+# Para cada escenario se comprueba que:
+#   - Las medias de las tres métricas caen dentro del IC_0.95 guardado en la referencia.
+#   - El tiempo real no supera el de referencia en más de TOLERANCIA (por uno) y los eventos por segundo no bajan
+#     más de TOLERANCIA.
+
+TOLERANCIA=${TOLERANCIA:-0.25}
+MAXPROC=${MAXPROC:-`nproc`}
+SEMILLA=1
+DIRREF="`dirname $0`/benchmark"
+
+#           nombre         parámetros
+ESCENARIOS=("pequeno-bajo  --nCsma=4  --mRetIni=2  --mRetFin=4"
+            "pequeno-alto  --nCsma=4  --mRetIni=14 --mRetFin=16"
+            "grande-bajo   --nCsma=20 --mRetIni=2  --mRetFin=4"
+            "grande-alto   --nCsma=20 --mRetIni=14 --mRetFin=16")
+
+ACTUALIZA=0
+if [ "$1" == "--actualiza" ]; then
+  ACTUALIZA=1
+fi
+
+ejecuta () {
+  if [ -n "$PRACTICA05" ]; then
+    $PRACTICA05 "$@"
+  else
+    waf --run "practica05_proc $*"
+  fi
+}
+
+# compara <referencia> <actual>: 0 si todo está dentro de tolerancia
+compara () {
+  awk -v tol=$TOLERANCIA '
+    FNR == 1 { fichero++ }
+    /^# tiempo/ { tiempo[fichero] = $3; evps[fichero] = $7; next }
+    /^#/ { next }
+    fichero == 1 { for (c = 2; c <= 7; c++) ref[$1, c] = $c; next }
+    {
+      split("Intentos Eco Porcen", metrica, " ")
+      for (m = 0; m < 3; m++) {
+        c = 2 + 2*m
+        d = $c - ref[$1, c]; if (d < 0) d = -d
+        if (d > ref[$1, c+1]) {
+          printf("  MaxRetries=%s: %s=%g fuera de [%g , %g]\n", $1, metrica[m+1], $c,
+                 ref[$1, c] - ref[$1, c+1], ref[$1, c] + ref[$1, c+1])
+          fallos++
+        }
+      }
+    }
+    END {
+      printf("  tiempo: %.2f s (ref. %.2f s), eventos/s: %.0f (ref. %.0f)\n", tiempo[2], tiempo[1], evps[2], evps[1])
+      if (tiempo[2] > tiempo[1] * (1 + tol)) { print "  Tiempo real fuera de tolerancia"; fallos++ }
+      if (evps[2] < evps[1] * (1 - tol))     { print "  Eventos por segundo fuera de tolerancia"; fallos++ }
+      exit (fallos > 0)
+    }' "$1" "$2"
+}
+
+
+FALLOS=0
+
+for escenario in "${ESCENARIOS[@]}"; do
+  set -- $escenario
+  nombre=$1; shift
+
+  echo "### Escenario $nombre"
+  ejecuta "$@" --semilla=$SEMILLA --maxProc=$MAXPROC || { FALLOS=$((FALLOS+1)); continue; }
+
+  if [ -n "$INFORME" ]; then
+    awk -v nombre=$nombre '/^# tiempo/ { print nombre, $3, $7 }' practica05-resumen.txt >> "$INFORME"
+  fi
+
+  if [ $ACTUALIZA -eq 1 ]; then
+    mkdir -p "$DIRREF"
+    cp practica05-resumen.txt "$DIRREF/$nombre.ref"
+    echo "  Referencia actualizada"
+  elif [ ! -f "$DIRREF/$nombre.ref" ]; then
+    echo "  Sin referencia. Ejecutar con --actualiza en la máquina de referencia"
+    FALLOS=$((FALLOS+1))
+  elif compara "$DIRREF/$nombre.ref" practica05-resumen.txt; then
+    echo "  OK"
+  else
+    FALLOS=$((FALLOS+1))
+  fi
+done
+
+echo "### $FALLOS escenario(s) con fallos"
+exit $FALLOS
@@ -0,0 +1,69 @@
+#!/bin/bash
+
+### Compilación optimizada con LTO y PGO de practica05_proc, y comparación con la compilación por defecto ###
+#
+# Uso:  ./ejecutaPGO.sh [prefijo de instalación de ns-3]
+#
+#   1. Compilación por defecto (Release, sin LTO ni PGO) en _build/base.
+#   2. Compilación instrumentada (LTO + PGO GENERA) en _build/pgo.
+#   3. Barrido de entrenamiento representativo con el binario instrumentado.
+#   4. Recompilación en el mismo directorio con los perfiles (LTO + PGO USA). Tiene que ser el mismo directorio:
+#      GCC identifica los perfiles por la ruta de cada objeto.
+#   5. ejecutaBenchmark.sh con ambos binarios, cada uno en su directorio (_build/base/bench y _build/pgo/bench) para
+#      que sus ficheros de salida no se pisen ni ensucien la raíz, y tabla comparativa en _build/resultadosPGO.txt.
+
+NS3=${1:+-DCMAKE_PREFIX_PATH=$1}
+RAIZ=`cd "$(dirname $0)" && pwd`
+MAXPROC=${MAXPROC:-`nproc`}
+
+BASE=$RAIZ/_build/base
+PGO=$RAIZ/_build/pgo
+PERFILES=$PGO/perfiles
+
+set -e
+
+# 1. Por defecto
+cmake -S "$RAIZ" -B "$BASE" $NS3 -DCMAKE_BUILD_TYPE=Release -DPRACTICA05_LTO=OFF -DPRACTICA05_PGO=NO
+cmake --build "$BASE" -j"$MAXPROC"
+
+# 2. Instrumentada
+rm -rf "$PERFILES"
+cmake -S "$RAIZ" -B "$PGO" $NS3 -DCMAKE_BUILD_TYPE=Release -DPRACTICA05_LTO=ON -DPRACTICA05_PGO=GENERA \
+      -DPRACTICA05_PGO_DIR="$PERFILES"
+cmake --build "$PGO" -j"$MAXPROC" --clean-first
+
+# 3. Entrenamiento: eje completo con paso grueso, varios segmentos y los tres perfiles de fidelidad
+mkdir -p "$PGO/entrenamiento"
+cd "$PGO/entrenamiento"
+for perfil in exacto rapido minimo; do
+  "$PGO/practica05_proc" --maxProc=$MAXPROC --semilla=1 --incMRet=4 --nSegmentos=2 --perfil=$perfil
+done
+if ls "$PERFILES"/*.profraw > /dev/null 2>&1; then # Clang: fusión de los perfiles de todos los procesos
+  llvm-profdata merge -o "$PERFILES/default.profdata" "$PERFILES"/*.profraw
+fi
+cd "$RAIZ"
+#   Sin perfiles la compilación USA saldría igual que una sin PGO y la comparación lo presentaría como PGO
+if [ ! -f "$PERFILES/default.profdata" ] && [ -z "`find "$PERFILES" -name '*.gcda' 2> /dev/null`" ]; then
+  echo "El entrenamiento no ha generado perfiles en $PERFILES (ni .gcda ni default.profdata)" >&2
+  exit 1
+fi
+
+# 4. Optimizada con los perfiles
+cmake -S "$RAIZ" -B "$PGO" -DPRACTICA05_PGO=USA
+cmake --build "$PGO" -j"$MAXPROC" --clean-first
+
+# 5. Comparación (los fallos frente a las referencias se muestran pero no detienen la comparación)
+set +e
+for build in "$BASE" "$PGO"; do
+  rm -rf "$build/bench" "$build/informe.txt"
+  mkdir -p "$build/bench"
+  (cd "$build/bench" && INFORME="$build/informe.txt" PRACTICA05="$build/practica05_proc" "$RAIZ/ejecutaBenchmark.sh")
+done
+
+FICHERO="$RAIZ/_build/resultadosPGO.txt"
+{
+echo "# escenario tiempoBase(s) tiempoPGO(s) aceleracion eventosPorSegundoBase eventosPorSegundoPGO"
+join <(sort "$BASE/informe.txt") <(sort "$PGO/informe.txt") | awk '{ printf("%s %.2f %.2f %.3f %.0f %.0f\n", $1, $2, $4, $2/$4, $3, $5) }'
+} > "$FICHERO"
+
+cat "$FICHERO"
@@ -0,0 +1,270 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../practica05_proc/FormatoColumnas.h"
+#include "../practica05_proc/Estadistica.h"
+
+/*
+    Lector del fichero columnar de réplicas que escribe practica05_proc (practica05-replicas.col).
+
+    Proyecta el fichero en memoria con mmap y recalcula, agrupando por una columna entera, la media y el IC_0.95 de
+  cada métrica. No necesita ns-3 ni vuelve a simular: cambiar la agrupación o el filtro cuesta milisegundos.
+
+    Uso:  lectorReplicas fichero.col [--esquema] [--agrupa=columna] [--filtro=columna=valor ...]
+
+      --esquema                  Muestra las columnas del fichero y termina.
+      --agrupa=columna           Columna entera por la que agrupar (nMaxRetries por defecto).
+      --filtro=columna=valor     Sólo filas cuya columna entera vale valor (p.ej. perfil=0). Se pueden encadenar.
+
+    La salida es texto en columnas, apta para gnuplot: valor del grupo, nº de réplicas (filas) del grupo y, para cada
+  métrica, media, semiamplitud del IC_0.95 y nº de réplicas con medida (n_metrica), que es el usado en el IC y puede
+  ser menor que el de filas si alguna réplica no midió esa métrica (NaN).
+*/
+
+typedef struct {                  // Acumulador de media y cuasivarianza (Welford). Se ignoran los NaN
+    uint64_t n;
+    double   media;
+    double   m2;
+} acumulador;
+
+typedef struct {                  // Filas de un grupo y acumuladores de cada métrica
+    uint64_t                filas;
+    std::vector<acumulador> acums;
+} grupo;
+
+typedef struct {                  // Condición de filtro sobre una columna entera
+    uint32_t columna;
+    uint64_t valor;
+} filtro;
+
+
+/*************** Declaración de funciones ***************/
+int buscaColumna (const cabeceraColumnas * cabecera, const descriptorColumna * esquema, std::string nombre);
+void acumula (acumulador * acum, double x);
+
+
+
+
+
+
+
+int
+main (int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Uso: " << argv[0] << " fichero.col [--esquema] [--agrupa=columna] [--filtro=columna=valor ...]"
+                  << std::endl;
+        return 1;
+    }
+
+
+    /******************* Proyección del fichero *******************/
+    int descriptor = open (argv[1], O_RDONLY);
+    struct stat info;
+    if (descriptor < 0 || fstat (descriptor, &info) < 0 || (size_t) info.st_size < sizeof(cabeceraColumnas))
+    {
+        std::cerr << "No se puede leer " << argv[1] << std::endl;
+        return 1;
+    }
+
+    const char * base = (const char *) mmap (0, info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close (descriptor);
+    if (base == MAP_FAILED)
+    {
+        std::cerr << "No se puede proyectar " << argv[1] << std::endl;
+        return 1;
+    }
+
+    const cabeceraColumnas * cabecera = (const cabeceraColumnas *) base;
+    const descriptorColumna * esquema = (const descriptorColumna *) (base + sizeof(cabeceraColumnas));
+    if (strncmp (cabecera->magica, COL_MAGICA, sizeof(cabecera->magica)) != 0
+        || sizeof(cabeceraColumnas) + cabecera->nColumnas * sizeof(descriptorColumna) > (size_t) info.st_size)
+    {
+        std::cerr << argv[1] << " no es un fichero de réplicas válido" << std::endl;
+        return 1;
+    }
+    for (uint32_t c = 0; c < cabecera->nColumnas; ++c)
+    {
+        if (esquema[c].desplazamiento + cabecera->nFilas * 8 > (uint64_t) info.st_size)
+        {
+            std::cerr << argv[1] << " está truncado (columna " << esquema[c].nombre << ")" << std::endl;
+            return 1;
+        }
+    }
+
+
+    /******************** Opciones de la consulta ********************/
+    int agrupa = buscaColumna (cabecera, esquema, "nMaxRetries");
+    std::vector<filtro> filtros;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string opcion = argv[i];
+        if (opcion == "--esquema")
+        {
+            std::cout << "# " << cabecera->nFilas << " filas" << std::endl;
+            for (uint32_t c = 0; c < cabecera->nColumnas; ++c)
+            {
+                std::cout << esquema[c].nombre << " " << (esquema[c].tipo == COL_U64 ? "u64" : "f64") << std::endl;
+            }
+            return 0;
+        }
+        else if (opcion.compare (0, 9, "--agrupa=") == 0)
+        {
+            agrupa = buscaColumna (cabecera, esquema, opcion.substr (9));
+        }
+        else if (opcion.compare (0, 9, "--filtro=") == 0 && opcion.find ('=', 9) != std::string::npos)
+        {
+            size_t igual = opcion.find ('=', 9);
+            filtro f;
+            int columna = buscaColumna (cabecera, esquema, opcion.substr (9, igual - 9));
+            if (columna < 0)
+            {
+                return 1;
+            }
+            f.columna = columna;
+            f.valor   = strtoull (opcion.c_str() + igual + 1, 0, 10);
+            filtros.push_back (f);
+        }
+        else
+        {
+            std::cerr << "Opción desconocida: " << opcion << std::endl;
+            return 1;
+        }
+    }
+    if (agrupa < 0)
+    {
+        return 1;
+    }
+
+
+    /************************** Agregación ***************************/
+    //   Las columnas se usan directamente sobre la proyección: la de agrupación como uint64_t y las métricas (f64)
+    // como double, sin copiar nada.
+    const uint64_t * claves = (const uint64_t *) (base + esquema[agrupa].desplazamiento);
+    std::vector<uint32_t> metricas;
+    for (uint32_t c = 0; c < cabecera->nColumnas; ++c)
+    {
+        if (esquema[c].tipo == COL_F64)
+        {
+            metricas.push_back (c);
+        }
+    }
+
+    std::map<uint64_t, grupo> grupos;
+    for (uint64_t fila = 0; fila < cabecera->nFilas; ++fila)
+    {
+        bool valida = true;
+        for (size_t f = 0; valida && f < filtros.size(); ++f)
+        {
+            valida = ((const uint64_t *) (base + esquema[filtros[f].columna].desplazamiento))[fila] == filtros[f].valor;
+        }
+        if (!valida)
+        {
+            continue;
+        }
+
+        grupo & g = grupos[claves[fila]];
+        std::vector<acumulador> & acums = g.acums;
+        if (acums.empty())
+        {
+            acumulador vacio = { 0, 0, 0 };
+            acums.assign (metricas.size(), vacio);
+            g.filas = 0;
+        }
+        g.filas++;
+        for (size_t m = 0; m < metricas.size(); ++m)
+        {
+            acumula (&acums[m], ((const double *) (base + esquema[metricas[m]].desplazamiento))[fila]);
+        }
+    }
+
+
+    /**************************** Salida *****************************/
+    std::cout << "# " << esquema[agrupa].nombre << " filas";
+    for (size_t m = 0; m < metricas.size(); ++m)
+    {
+        std::cout << " " << esquema[metricas[m]].nombre << " z_" << esquema[metricas[m]].nombre
+                  << " n_" << esquema[metricas[m]].nombre;
+    }
+    std::cout << std::endl;
+
+    for (std::map<uint64_t, grupo>::iterator it = grupos.begin(); it != grupos.end(); ++it)
+    {
+        std::cout << it->first << " " << it->second.filas;
+        for (size_t m = 0; m < metricas.size(); ++m)
+        {
+            acumulador & a = it->second.acums[m];
+            double z = a.n > 1 ? tStudent (a.n - 1) * sqrt (a.m2 / (a.n - 1) / a.n) : NAN;
+            std::cout << " " << (a.n > 0 ? a.media : NAN) << " " << z << " " << a.n;
+        }
+        std::cout << std::endl;
+    }
+
+    munmap ((void *) base, info.st_size);
+    return 0;
+}
+
+
+
+
+
+
+
+int
+buscaColumna (const cabeceraColumnas * cabecera, const descriptorColumna * esquema, std::string nombre)
+{
+    /*
+        Devuelve el índice de la columna entera con ese nombre, o -1 (avisando por stderr) si no existe o es real.
+    */
+
+    for (uint32_t c = 0; c < cabecera->nColumnas; ++c)
+    {
+        if (nombre == esquema[c].nombre)
+        {
+            if (esquema[c].tipo != COL_U64)
+            {
+                std::cerr << "La columna " << nombre << " no es entera" << std::endl;
+                return -1;
+            }
+            return c;
+        }
+    }
+
+    std::cerr << "No existe la columna " << nombre << std::endl;
+    return -1;
+}
+
+
+void
+acumula (acumulador * acum, double x)
+{
+    /*
+        Actualización de media y suma de cuadrados de desviaciones (Welford). Como en el Observador, una réplica sin
+      medida (NaN) no cuenta.
+    */
+
+    if (x != x)
+    {
+        return;
+    }
+
+    acum->n++;
+    double delta = x - acum->media;
+    acum->media += delta / acum->n;
+    acum->m2    += delta * (x - acum->media);
+}
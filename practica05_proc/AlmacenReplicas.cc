@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include <string.h>
+#include <fstream>
+
+#include "AlmacenReplicas.h"
+
+
+static const char * NOMBRES[COL_TOTAL] = {        // Nombres de columna del esquema, en el orden del enum
+    "nMaxRetries", "nCsma", "tamPaquete", "intervaloUs", "capacidadBps", "retardoPropNs", "nSegmentos", "perfil", "semilla", "run", "segmento",
+    "intentos", "ecoUs", "porcenCorrectos"
+};
+
+
+
+
+
+
+
+AlmacenReplicas::AlmacenReplicas (uint32_t nCsma, uint32_t tamPaquete, uint64_t intervaloUs, uint64_t capacidadBps,
+                                  uint64_t retardoPropNs, uint32_t nSegmentos)
+{
+    /*
+        Constructor de AlmacenReplicas. Recibe los parámetros que no cambian a lo largo del barrido, que se guardan
+      igualmente como columnas para que cada fila sea autocontenida al agrupar o filtrar. Todos los que influyen en
+      los resultados, en unidades enteras (us, bit/s, ns) para que se puedan usar como claves de agrupación.
+
+        El almacén guarda en memoria, por columnas, los resultados de cada réplica que el padre recibe de los hijos, en
+      lugar de descartarlos tras actualizar los acumuladores.
+    */
+
+    m_parametros[COL_MAXRETRIES]  = 0;               // Varía por fila: lo da Anade
+    m_parametros[COL_NCSMA]       = nCsma;
+    m_parametros[COL_TAMPAQUETE]  = tamPaquete;
+    m_parametros[COL_INTERVALO]   = intervaloUs;
+    m_parametros[COL_CAPACIDAD]   = capacidadBps;
+    m_parametros[COL_RETARDOPROP] = retardoPropNs;
+    m_parametros[COL_NSEGMENTOS]  = nSegmentos;
+}
+
+
+void
+AlmacenReplicas::Anade (uint32_t nMaxRetries, uint32_t perfil, uint32_t semilla, uint64_t run, uint32_t segmento,
+                        double intentos, double eco, double porcen)
+{
+    /*
+        Este método añade una fila (una réplica). perfil es el índice en la tabla de perfiles de simulación y
+      semilla/run/segmento identifican la réplica para poder reproducirla.
+    */
+
+    m_enteros[COL_MAXRETRIES].push_back(nMaxRetries);
+    for (uint32_t c = COL_MAXRETRIES + 1; c < COL_PERFIL; ++c)
+    {
+        m_enteros[c].push_back(m_parametros[c]);
+    }
+    m_enteros[COL_PERFIL].push_back(perfil);
+    m_enteros[COL_SEMILLA].push_back(semilla);
+    m_enteros[COL_RUN].push_back(run);
+    m_enteros[COL_SEGMENTO].push_back(segmento);
+
+    m_reales[COL_INTENTOS - COL_INTENTOS].push_back(intentos);
+    m_reales[COL_ECO - COL_INTENTOS].push_back(eco);
+    m_reales[COL_PORCEN - COL_INTENTOS].push_back(porcen);
+}
+
+
+bool
+AlmacenReplicas::Escribe (std::string fichero)
+{
+    /*
+        Este método escribe el almacén en el formato de FormatoColumnas.h: cabecera, esquema y una columna tras otra.
+      Devuelve false si no se ha podido escribir el fichero.
+    */
+
+    uint64_t nFilas = m_enteros[COL_MAXRETRIES].size();
+
+    cabeceraColumnas cabecera;
+    memset (&cabecera, 0, sizeof(cabecera));
+    strncpy (cabecera.magica, COL_MAGICA, sizeof(cabecera.magica));
+    cabecera.nColumnas = COL_TOTAL;
+    cabecera.nFilas    = nFilas;
+
+    descriptorColumna esquema[COL_TOTAL];
+    uint64_t desplazamiento = sizeof(cabecera) + sizeof(esquema); // Ambos son múltiplos de 8
+    for (uint32_t c = 0; c < COL_TOTAL; ++c)
+    {
+        memset (&esquema[c], 0, sizeof(esquema[c]));
+        strncpy (esquema[c].nombre, NOMBRES[c], COL_NOMBRE - 1);
+        esquema[c].tipo           = c < COL_INTENTOS ? COL_U64 : COL_F64;
+        esquema[c].desplazamiento = desplazamiento;
+        desplazamiento           += nFilas * 8;
+    }
+
+    std::ofstream salida (fichero.c_str(), std::ios::binary);
+    salida.write ((const char *) &cabecera, sizeof(cabecera));
+    salida.write ((const char *) esquema, sizeof(esquema));
+    for (uint32_t c = 0; c < COL_TOTAL && nFilas > 0; ++c)
+    {
+        const char * datos = c < COL_INTENTOS ? (const char *) &m_enteros[c][0]
+                                              : (const char *) &m_reales[c - COL_INTENTOS][0];
+        salida.write (datos, nFilas * 8);
+    }
+    salida.close ();
+
+    return !salida.fail();
+}
@@ -0,0 +1,48 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "FormatoColumnas.h"
+
+
+
+// Columnas del almacén, en el orden en que se escriben
+enum {
+    COL_MAXRETRIES = 0,
+    COL_NCSMA,
+    COL_TAMPAQUETE,
+    COL_INTERVALO,
+    COL_CAPACIDAD,
+    COL_RETARDOPROP,
+    COL_NSEGMENTOS,
+    COL_PERFIL,
+    COL_SEMILLA,
+    COL_RUN,
+    COL_SEGMENTO,
+    COL_INTENTOS,
+    COL_ECO,
+    COL_PORCEN,
+    COL_TOTAL
+};
+
+
+
+class AlmacenReplicas
+{
+public:
+    AlmacenReplicas (uint32_t nCsma, uint32_t tamPaquete, uint64_t intervaloUs, uint64_t capacidadBps,
+                     uint64_t retardoPropNs, uint32_t nSegmentos);
+
+    void     Anade  (uint32_t nMaxRetries, uint32_t perfil, uint32_t semilla, uint64_t run, uint32_t segmento,
+                     double intentos, double eco, double porcen);
+
+    bool     Escribe (std::string fichero);
+
+private:
+    uint64_t              m_parametros[COL_PERFIL];    // Parámetros fijos de todo el barrido (columnas 0..COL_PERFIL-1)
+
+    std::vector<uint64_t> m_enteros[COL_INTENTOS];     // Columnas enteras (parámetros y semillas)
+    std::vector<double>   m_reales[COL_TOTAL - COL_INTENTOS]; // Columnas reales (métricas)
+};
@@ -0,0 +1,56 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef ESTADISTICA_H
+#define ESTADISTICA_H
+
+#include <stdint.h>
+
+
+/*
+    Utilidades estadísticas comunes al simulador y a lectorReplicas. No depende de ns-3.
+*/
+
+inline double
+tStudent (uint64_t gradosLibertad)
+{
+    /*
+        Cuantil t_{gl, 0.025} para el IC_0.95. Tabla hasta 30 grados de libertad; a partir de ahí, aproximación normal.
+    */
+
+    static const double TABLA[30] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+
+    if (gradosLibertad >= 1 && gradosLibertad <= 30)
+    {
+        return TABLA[gradosLibertad - 1];
+    }
+
+    return 1.960;
+}
+
+inline double
+tStudent05 (uint64_t gradosLibertad)
+{
+    /*
+        Cuantil t_{gl, 0.05} para los contrastes unilaterales al 5% (TOST), es decir, el IC_0.90. Misma tabla y
+      aproximación que tStudent().
+    */
+
+    static const double TABLA[30] = {
+        6.314, 2.920, 2.353, 2.132, 2.015, 1.943, 1.895, 1.860, 1.833, 1.812,
+        1.796, 1.782, 1.771, 1.761, 1.753, 1.746, 1.740, 1.734, 1.729, 1.725,
+        1.721, 1.717, 1.714, 1.711, 1.708, 1.706, 1.703, 1.701, 1.699, 1.697
+    };
+
+    if (gradosLibertad >= 1 && gradosLibertad <= 30)
+    {
+        return TABLA[gradosLibertad - 1];
+    }
+
+    return 1.645;
+}
+
+#endif
@@ -0,0 +1,44 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef FORMATO_COLUMNAS_H
+#define FORMATO_COLUMNAS_H
+
+#include <stdint.h>
+
+
+/*
+    Formato del fichero columnar de réplicas (practica05-replicas.col). Lo comparten el simulador, que lo escribe, y
+  lectorReplicas, que lo proyecta en memoria con mmap. No depende de ns-3.
+
+    Disposición (orden de bytes de la máquina que lo escribe):
+
+      cabeceraColumnas
+      descriptorColumna x nColumnas
+      columna 0: nFilas valores de 8 bytes
+      columna 1: ...
+
+    Cada descriptor indica el desplazamiento de su columna desde el inicio del fichero, siempre múltiplo de 8, para
+  poder usar los datos proyectados directamente como arrays de uint64_t o double.
+*/
+
+#define COL_MAGICA  "P05COL1"     // Identificador de formato (8 bytes con el '\0')
+#define COL_NOMBRE  24            // Longitud máxima del nombre de columna (con el '\0')
+
+#define COL_U64     0             // Tipos de columna
+#define COL_F64     1
+
+typedef struct {
+    char     magica[8];
+    uint32_t nColumnas;
+    uint32_t reservado;
+    uint64_t nFilas;
+} cabeceraColumnas;
+
+typedef struct {
+    char     nombre[COL_NOMBRE];
+    uint32_t tipo;                // COL_U64 o COL_F64
+    uint32_t reservado;
+    uint64_t desplazamiento;      // Bytes desde el inicio del fichero
+} descriptorColumna;
+
+#endif
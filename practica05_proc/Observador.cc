@@ -11,7 +11,7 @@ NS_LOG_COMPONENT_DEFINE ("Observador");
 
 
 
-Observador::Observador (NetDeviceContainer * csmaDevices)
+Observador::Observador (NetDeviceContainer * csmaDevices, bool metricaEco)
 {
     NS_LOG_FUNCTION_NOARGS (); // Sin argumentos. Aunque el constructor tiene argumentos, no nos aporta nada
     /* 
@@ -22,9 +22,19 @@ Observador::Observador (NetDeviceContainer * csmaDevices)
         En el constructor del Observador se hacen las suscripciones a las trazas necesarias. También se obtiene el
       número de nodos de la topología, que se podría pasar como argumento, pero así se hace la llamada lo más simple
       posible.
+
+        Si metricaEco es falso no se suscriben las trazas MacTx/MacRx, que desencapsulan cada trama, y los tiempos de
+      eco no se miden (MediaEco no tendrá sentido). Lo usan los perfiles de simulación que no necesitan esa métrica.
     */
 
     uint32_t nCsma = csmaDevices->GetN();             // Número de nodos en la topología
+    m_nCsma = nCsma;
+    m_metricaEco = metricaEco;
+
+    m_anillo   = 0;                                   // Sin serie temporal hasta que se llame a ActivarVentanas
+    m_tCierre  = 0;
+    m_salida   = 0;
+    m_capacidad = m_cabeza = m_ocupadas = m_nVentana = 0;
 
     m_observadorDevice = new ObservadorDevice[nCsma]; // Se instancian nCsma objetos de tipo ObservadorDevice
 
@@ -42,7 +52,7 @@ Observador::Observador (NetDeviceContainer * csmaDevices)
         csmaDevices->Get (i)->TraceConnectWithoutContext("PhyTxDrop", MakeCallback(&ObservadorDevice::PaquetePerdido, &m_observadorDevice[i]));
     }
 
-    for (uint32_t i = 0; i < nCsma-1; ++i) // Se excluye la suscrip. del servidor para los cálculos de tiempos de eco
+    for (uint32_t i = 0; metricaEco && i < nCsma-1; ++i) // Se excluye la suscrip. del servidor para los tiempos de eco
     {
         // Paquete listo para intentar transmitirlo y paquete listo para ser entregado al nivel de red
         csmaDevices->Get (i)->TraceConnectWithoutContext("MacTx", MakeCallback(&ObservadorDevice::EchoRequest, &m_observadorDevice[i]));
@@ -119,7 +129,8 @@ Observador::MediaEco (uint32_t desde, uint32_t hasta)
         
         Para el obtener el dato se calcula la media de las medias de intentos de cada nodo cliente.
 
-        Si no se han transmitido paquetes en algún nodo el valor del Time devuelto será negativo (conversión de NaN).
+        Los nodos sin ningún eco completado (MediaEco negativo) no cuentan. Si no cuenta ninguno, se devuelve un Time
+      negativo (-1 us) para indicarlo, sin convertir NaN a entero.
     */
 
     Average<int64_t> acumtEcoTotal; // Variable local al método
@@ -135,10 +146,29 @@ Observador::MediaEco (uint32_t desde, uint32_t hasta)
         }
     }
 
+    if (acumtEcoTotal.Count() == 0) // Ningún nodo con ecos: no hay media
+    {
+        return MicroSeconds(-1);
+    }
+
     return MicroSeconds( (int64_t) acumtEcoTotal.Avg() );
 }
 
 
+double
+Observador::VarianzaEco (uint32_t device)
+{
+    NS_LOG_FUNCTION (device);
+    /* 
+        Este método devuelve por nodo (el indicado como argumento) la cuasivarianza del tiempo de eco, en us^2.
+        
+        Para el obtener el dato se llama al método VarianzaEco del ObservadorDevice del nodo en cuestión.
+    */
+
+    return m_observadorDevice[device].VarianzaEco();
+}
+
+
 double
 Observador::PorcenPaqPerdidos (uint32_t device)
 {
@@ -174,6 +204,125 @@ Observador::PorcenPaqPerdidos (uint32_t desde, uint32_t hasta)
 }
 
 
+void
+Observador::ActivarVentanas (Time tVentana, Time tFin, uint32_t capacidad, std::ostream * salida)
+{
+    NS_LOG_FUNCTION (tVentana << tFin << capacidad);
+    /*
+        Este método activa la obtención de una serie temporal de contadores por dispositivo: cada tVentana de tiempo
+      simulado se cierra una ventana con las transmisiones, backoffs, descartes y ecos completados en ella.
+
+        Las ventanas cerradas se guardan en un buffer circular reservado aquí una única vez (capacidad x nCsma), de
+      forma que en las funciones de traza sólo se incrementan contadores, sin reservas de memoria ni escrituras. Cuando
+      el anillo se llena se vuelca en CSV sobre el flujo salida.
+
+        El cierre de ventanas se programa como un evento periódico que deja de reprogramarse al alcanzar tFin. Si no,
+      la simulación no terminaría nunca al no quedarse sin eventos.
+    */
+
+    m_tVentana  = tVentana;
+    m_tFin      = tFin;
+    m_capacidad = capacidad;
+    m_salida    = salida;
+
+    delete [] m_anillo;
+    delete [] m_tCierre;
+    m_anillo    = new contadoresVentana[capacidad * m_nCsma];
+    m_tCierre   = new double[capacidad];
+    m_cabeza    = m_ocupadas = m_nVentana = 0;
+
+    *m_salida << "ventana,tInicio,tFin,nodo,transmisiones,backoffs,descartes,ecos" << std::endl;
+
+    Simulator::Schedule (m_tVentana, &Observador::CierraVentana, this);
+}
+
+
+void
+Observador::FinalizarVentanas ()
+{
+    NS_LOG_FUNCTION_NOARGS ();
+    /*
+        Este método se llama tras Simulator::Run(). Cierra la última ventana (la que recoge lo ocurrido tras la última
+      frontera programada, p.ej. ecos en vuelo tras TSTOP) y vuelca lo que quede en el anillo. Esa ventana de cola no
+      dura tVentana sino hasta el último evento de la simulación, y así figura en su tFin.
+    */
+
+    if (m_salida == 0) // Si no se activaron las ventanas...
+    {
+        return;
+    }
+
+    CierraVentana ();
+    VolcarVentanas ();
+    m_salida->flush ();
+}
+
+
+void
+Observador::CierraVentana ()
+{
+    /*
+        Este método se ejecuta en cada frontera de ventana. Copia los contadores de cada dispositivo en la siguiente
+      posición libre del anillo y los pone a cero. Si el anillo se llena, se vuelca.
+
+        No lleva NS_LOG_FUNCTION porque está en el camino de cada ventana y no aporta información.
+    */
+
+    uint32_t posicion = (m_cabeza + m_ocupadas) % m_capacidad;
+    contadoresVentana * ventana = &m_anillo[posicion * m_nCsma];
+    m_tCierre[posicion] = Simulator::Now().GetSeconds();
+    for (uint32_t i = 0; i < m_nCsma; ++i)
+    {
+        ventana[i] = m_observadorDevice[i].CierraVentana();
+    }
+
+    if (++m_ocupadas == m_capacidad) // Anillo lleno
+    {
+        VolcarVentanas ();
+    }
+
+    if (Simulator::Now() + m_tVentana <= m_tFin) // Siguiente frontera, si procede
+    {
+        Simulator::Schedule (m_tVentana, &Observador::CierraVentana, this);
+    }
+}
+
+
+void
+Observador::VolcarVentanas ()
+{
+    NS_LOG_FUNCTION (m_ocupadas);
+    /*
+        Este método escribe en CSV las ventanas pendientes del anillo, de la más antigua a la más reciente, y deja el
+      anillo vacío. Una fila por ventana y nodo.
+
+        Sin métrica de eco el campo ecos se deja vacío: un 0 no se distinguiría de "ningún eco completado".
+    */
+
+    for (uint32_t v = 0; v < m_ocupadas; ++v)
+    {
+        uint32_t posicion = (m_cabeza + v) % m_capacidad;
+        contadoresVentana * ventana = &m_anillo[posicion * m_nCsma];
+        double tInicio = (m_nVentana + v) * m_tVentana.GetSeconds();
+        for (uint32_t i = 0; i < m_nCsma; ++i)
+        {
+            *m_salida << m_nVentana + v << "," << tInicio << "," << m_tCierre[posicion] << "," << i << ","
+                      << ventana[i].transmisiones << "," << ventana[i].backoffs << ","
+                      << ventana[i].descartes << ",";
+            if (m_metricaEco)
+            {
+                *m_salida << ventana[i].ecos;
+            }
+            *m_salida << "\n";
+        }
+    }
+
+    m_cabeza    = (m_cabeza + m_ocupadas) % m_capacidad;
+    m_nVentana += m_ocupadas;
+    m_ocupadas  = 0;
+}
+
+
 
 
 
@@ -191,6 +340,8 @@ ObservadorDevice::ObservadorDevice ()
 
     m_intentos    = 1;
     m_descartados = 0;
+
+    m_ventana.transmisiones = m_ventana.backoffs = m_ventana.descartes = m_ventana.ecos = 0;
 }
 
 
@@ -207,6 +358,7 @@ ObservadorDevice::PaqueteEnviado (Ptr<const Packet> paquete)
     */
 
     m_acumIntentos.Update(m_intentos);
+    m_ventana.transmisiones++;
     NS_LOG_DEBUG ("NODO " << m_idDevice << ": UIDPaq " << paquete->GetUid() << ": " << "Envío tras " << m_intentos << " intentos");
 
     m_intentos = 1;
@@ -225,6 +377,7 @@ ObservadorDevice::Colision (Ptr<const Packet> paquete)
     */
 
     m_intentos++;
+    m_ventana.backoffs++;
 }
 
 
@@ -329,6 +482,7 @@ ObservadorDevice::EchoResponse (Ptr<const Packet> paquete)
         {
             Time tResponse = Simulator::Now(); // Variable auxiliar
             m_acumtEco.Update( operator- (tResponse, m_tRequest).GetMicroSeconds() ); // Se actualiza con tiempo de eco
+            m_ventana.ecos++;
             NS_LOG_DEBUG ("NODO " << m_idDevice << ": UIDPaq " << paquete->GetUid() << ": " << "Respuesta de Eco en " << tResponse);
         }
     }
@@ -346,15 +500,40 @@ ObservadorDevice::MediaEco ()
         Se utiliza la conversión a int64_t porque MicroSeconds espera ese tipo. En dicha conversión se truncan los
       decimales, pero como la resolución de Time es del microsegundo, no tiene importancia.
 
-        Si el protocolo no ha completado ningún eco, m_acumtEco.Avg() devolverá "NaN" ya que no se ha podido tomar
-      ninguna medida. El valor asignado al Time es inesperado.
-
+        Si el protocolo no ha completado ningún eco (o no se miden, con metricaEco falso), m_acumtEco.Avg() sería "NaN"
+      y su conversión a entero no está definida. En ese caso se devuelve un Time negativo (-1 us), que el resto del
+      código interpreta como "sin medida".
     */
 
+    if (m_acumtEco.Count() == 0)
+    {
+        return MicroSeconds(-1);
+    }
+
     return MicroSeconds( (int64_t) m_acumtEco.Avg() );                                                      
 }
 
 
+double
+ObservadorDevice::VarianzaEco ()
+{
+    NS_LOG_FUNCTION_NOARGS ();
+    /*
+        Este método devuelve la cuasivarianza de los tiempos de eco medidos (us^2). Junto con MediaEco permite ver la
+      dispersión del tiempo de eco de cada cliente y no sólo su valor medio.
+
+        Con menos de dos ecos completados no hay cuasivarianza y se devuelve "NaN".
+    */
+
+    if (m_acumtEco.Count() < 2)
+    {
+        return NAN;
+    }
+
+    return m_acumtEco.Var();
+}
+
+
 void
 ObservadorDevice::PaquetePerdido (Ptr<const Packet> paquete)
 {
@@ -369,6 +548,7 @@ ObservadorDevice::PaquetePerdido (Ptr<const Packet> paquete)
     */
 
     m_descartados++;
+    m_ventana.descartes++;
     NS_LOG_DEBUG ("NODO " << m_idDevice << ": UIDPaq " << paquete->GetUid() << ": " << "Descarte tras " << m_intentos << " intentos");
     m_intentos = 1;
 }
@@ -403,4 +583,20 @@ ObservadorDevice::SetIdDevice(uint32_t idDevice)
     */
 
     m_idDevice = idDevice;
+}
+
+
+contadoresVentana
+ObservadorDevice::CierraVentana ()
+{
+    /*
+        Este método devuelve los contadores de la ventana en curso y los pone a cero para la siguiente. Lo llama el
+      Observador en cada frontera de ventana.
+    */
+
+    contadoresVentana ventana = m_ventana;
+
+    m_ventana.transmisiones = m_ventana.backoffs = m_ventana.descartes = m_ventana.ecos = 0;
+
+    return ventana;
 }
\ No newline at end of file
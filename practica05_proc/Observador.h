@@ -13,6 +13,15 @@ using namespace ns3;
 
 
 
+typedef struct {                                        // Contadores de un dispositivo en una ventana de tiempo simulado
+    uint32_t transmisiones;                             // Paquetes enviados completamente (PhyTxEnd)
+    uint32_t backoffs;                                  // Esperas de backoff tras detectar colisión (MacTxBackoff)
+    uint32_t descartes;                                 // Paquetes descartados por MaxRetries (PhyTxDrop)
+    uint32_t ecos;                                      // Ecos completados (respuestas UDP entregadas por MacRx)
+} contadoresVentana;
+
+
+
 // Dos clases en el mismo fichero, para ajustarse a la entrega
 
 class ObservadorDevice
@@ -29,6 +38,7 @@ public:
     void    EchoResponse      (Ptr<const Packet> paquete);
 
     Time    MediaEco          ();
+    double  VarianzaEco       ();
 
     void    PaquetePerdido    (Ptr<const Packet> paquete);
 
@@ -36,6 +46,8 @@ public:
 
     void    SetIdDevice(uint32_t idDevice);
 
+    contadoresVentana CierraVentana ();
+
 private:
     uint32_t           m_intentos;                      // Contador de intentos de envío de los paquetes
     Average<uint32_t>  m_acumIntentos;                  // Acumulador para cálculos estadísticos de los intentos
@@ -46,6 +58,8 @@ private:
     uint32_t           m_descartados;                   // Contador de paquetes que se descartan (por MaxRetries)
 
     uint32_t           m_idDevice;                      // Identificador del nodo asociado al observador. Para logs
+
+    contadoresVentana  m_ventana;                       // Contadores de la ventana temporal en curso
 };
 
 
@@ -57,17 +71,22 @@ private:
 class Observador
 {
 public:
-    Observador (NetDeviceContainer * csmaDevices);
+    Observador (NetDeviceContainer * csmaDevices, bool metricaEco = true);
                                                                  // Resultados para:
     double   MediaIntentos     (uint32_t device);                // Dispositivo device indicado
     double   MediaIntentos     (uint32_t desde, uint32_t hasta); // Rango de dispositivos (extremos incluidos)
 
     Time     MediaEco          (uint32_t device);                // Cliente device indicado
     Time     MediaEco          (uint32_t desde, uint32_t hasta); // Rango de dispositivos (extremos incluidos)
+    double   VarianzaEco       (uint32_t device);                // Cliente device indicado (us^2)
 
     double   PorcenPaqPerdidos (uint32_t device);                // Dispositivo device indicado
     double   PorcenPaqPerdidos (uint32_t desde, uint32_t hasta); // Rango de dispositivos (extremos incluidos)
 
+    // Serie temporal de contadores por ventanas (opcional)
+    void     ActivarVentanas   (Time tVentana, Time tFin, uint32_t capacidad, std::ostream * salida);
+    void     FinalizarVentanas ();
+
     ~Observador ()
     {
         /* 
@@ -77,8 +96,25 @@ public:
         */
 
         delete [] m_observadorDevice;
+        delete [] m_anillo;
+        delete [] m_tCierre;
     }
 
 private:
+    void     CierraVentana     ();
+    void     VolcarVentanas    ();
+
     ObservadorDevice * m_observadorDevice;                       // Array de objetos ObservadorDevice, uno por nodo
+    uint32_t           m_nCsma;                                  // Número de nodos (tamaño de m_observadorDevice)
+    bool               m_metricaEco;                             // Si se miden tiempos de eco (trazas MacTx/MacRx)
+
+    Time               m_tVentana;                               // Duración de cada ventana (tiempo simulado)
+    Time               m_tFin;                                   // Última frontera de ventana que se programa
+    contadoresVentana * m_anillo;                                // Buffer circular: capacidad ventanas x nCsma nodos
+    double           * m_tCierre;                                // Instante de cierre (s) de cada ventana del anillo
+    uint32_t           m_capacidad;                              // Número de ventanas que caben en el anillo
+    uint32_t           m_cabeza;                                 // Posición de la ventana más antigua sin volcar
+    uint32_t           m_ocupadas;                               // Ventanas cerradas pendientes de volcar
+    uint32_t           m_nVentana;                               // Índice global de la ventana más antigua sin volcar
+    std::ostream     * m_salida;                                 // Flujo CSV de destino. 0 si no hay ventanas
 };
\ No newline at end of file
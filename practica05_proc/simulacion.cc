@@ -1,6 +1,10 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 
 #include <unistd.h>
+#include <sys/time.h>
+#include <map>
+#include <memory>
+#include <vector>
 #define LEC 0       // Descriptores de lectura y escritura
 #define ESC 1
 
@@ -13,6 +17,8 @@
 
 #include "ns3/gnuplot.h"
 #include "Observador.h"
+#include "AlmacenReplicas.h"
+#include "Estadistica.h"
 
 #define DNI_0     9               // Última cifra del DNI           (DNI: ******59)
 #define DNI_1     5               // Penúltima cifra del DNI
@@ -30,30 +36,77 @@
 
 #define SIMPP     15              // Simulaciones por punto (Al menos 10).
 
+#define PASOINI   4               // Barrido adaptativo: separación inicial entre puntos, en incrementos de MaxRetries
+
+#define CAPVENT   64              // CAPacidad (en ventanas) del anillo de contadores por VENTanas del Observador
+
 #define T_14_025  2.1448          // t_i_j  :  i=n-1  ;  j=(1-p)/2
 
+#define MARGENAB  0.01            // Margen de equivalencia A/B por defecto: 1% de la media del perfil exacto
+
 typedef struct {                  // Struct para el paso de parámetros fijados a la función simulación
     uint32_t nCsma;
     Time     retardoProp;
     DataRate capacidad;
     uint32_t tamPaquete;
     Time     intervalo;
+    Time     tVentana;            // Duración de las ventanas de contadores. 0 para no generar serie temporal
+    uint32_t nSegmentos;          // Segmentos CSMA independientes (réplicas) en cada simulación
 } parametros;
 
+typedef struct {                  // Perfil de fidelidad: ajustes que cuestan CPU en cada paquete
+    const char * nombre;
+    bool     checksum;            // ChecksumEnabled (cálculo y comprobación de checksums IP/UDP)
+    bool     metricaEco;          // El Observador mide tiempos de eco (desencapsula cada trama en MacTx/MacRx)
+} perfil;
+
+//   El primero es la referencia para el modo A/B. La resolución de Time (US) es común a todos los perfiles: forma
+// parte del modelo (trunca retardoProp) y debe fijarse antes de crear cualquier Time, al leer los parámetros.
+static const perfil PERFILES[] = {
+    { "exacto", true,  true  },   // Comportamiento original
+    { "rapido", false, true  },   // Sin checksums. Mismas métricas
+    { "minimo", false, false }    // Sin checksums ni tiempos de eco. Sólo intentos y porcentaje de correctos
+};
+
 typedef struct {                  // Struct para la devolución de valores de la función simulación
     double nMediaIntentos;
     Time tMediaEco;
     double porcenPaqTxCorrect;
+    uint32_t semilla;             // Identificación de la réplica, para el almacén de réplicas: semilla, run y
+    uint64_t run;                 // segmento dentro de la simulación
+    uint32_t segmento;
 } resultados;
 
+typedef struct {                  // Media e IC_0.95 (semiamplitud) de las tres métricas en un punto del barrido
+    double media[3];              // Intentos, tiempo de eco (us) y porcentaje de correctos
+    double z[3];
+} punto;
+
+typedef struct {                  // Resultados de un nodo en una réplica. Se envían como bloque binario por la tubería
+    double intentos;              // Número medio de intentos por paquete
+    double mediaEco;              // Tiempo medio de eco (us). NaN en el servidor o si no se midió
+    double varEco;                // Cuasivarianza del tiempo de eco (us^2). NaN si no hay al menos 2 ecos
+    double porcenPerdidos;        // Porcentaje de paquetes perdidos (por MaxRetries)
+} resultadosNodo;
+
 
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("practica05");
 
 /*************** Declaración de funciones ***************/
-resultados simulacion (uint32_t nMaxRetries, parametros * param);
-void logsDebug (uint32_t nCsma, Observador * observador);
+pid_t replicas (uint32_t nMaxRetries, parametros * param, const perfil * prf, uint32_t maxProc, uint32_t semilla,
+                resultados * res, resultadosNodo * nodos, uint64_t * nEventos);
+uint64_t simulacion (uint32_t nMaxRetries, parametros * param, const perfil * prf, uint32_t nSegmentos, resultados * res,
+                     resultadosNodo * nodos);
+void resumenNodos (std::ostream & salida, uint32_t nMaxRetries, uint32_t nCsma, resultadosNodo * nodos);
+double semiamplitud (Average<double> & acum);
+void leeCompleto (int descriptor, void * buffer, size_t tam);
+bool equivalentes (double * ref, double * prueba, double margen, double * mediaRef, double * difMedia, double * z,
+                   uint32_t * nPares);
+double reloj ();
+double ecoUs (const resultados & res);
+bool siguientePunto (std::map<uint32_t, punto> & puntos, uint32_t incMRet, bool metricaEco, uint32_t * siguiente);
 
 
 
@@ -64,8 +117,7 @@ void logsDebug (uint32_t nCsma, Observador * observador);
 int
 main (int argc, char *argv[])
 {
-    GlobalValue::Bind("ChecksumEnabled", BooleanValue(true));
-    Time::SetResolution (Time::US);
+    Time::SetResolution (Time::US); // ChecksumEnabled lo fija cada hijo según el perfil
 
 
     /*********** Parámetros por línea de comandos ***********/
@@ -74,10 +126,25 @@ main (int argc, char *argv[])
         .retardoProp = Time("6560ns"),      // Se truncará a microsegundos (unidad de resolución)
         .capacidad   = DataRate("100Mb/s"),
         .tamPaquete  = TAMPQ_DEF,           // Valor por defecto en función del DNI
-        .intervalo   = Time("1s")
+        .intervalo   = Time("1s"),
+        .tVentana    = Time("0s"),          // Sin serie temporal por defecto
+        .nSegmentos  = 1                    // Una réplica por simulación (comportamiento original)
     };
 
     uint32_t maxProc = 1;                   // Número máximo de procesos hijo a crear
+    uint32_t semilla = 0;                   // Semilla común a todas las réplicas. 0 para usar el PID de cada hijo
+
+    uint32_t mRetIni = MRETINI;             // Eje de abcisas. Por defecto, el fijado en compilación
+    uint32_t incMRet = INCMRET;
+    uint32_t mRetFin = MRETFIN;
+
+    std::string nombrePerfil = "exacto";    // Perfil de fidelidad de la simulación
+    bool     ab = false;                    // Modo A/B: se ejecuta también el perfil exacto y se contrasta
+    double   margenAB = MARGENAB;
+
+    bool     adaptativo = false;            // Barrido adaptativo del eje de MaxRetries
+    uint32_t pasoIni = PASOINI;
+    uint32_t presupuesto = 0;               // Réplicas totales del barrido adaptativo. 0: la mitad del uniforme
 
     // Se confía en el buen uso del usuario para que no introduzca valores anómalos.
     CommandLine cmd;
@@ -87,9 +154,38 @@ main (int argc, char *argv[])
     cmd.AddValue ("capacidad", "Capacidad del bus", param.capacidad);
     cmd.AddValue ("tamPaquete", "Tamaño de las SDU de aplicación", param.tamPaquete);
     cmd.AddValue ("intervalo", "Tiempo entre dos paquetes consecutivos enviados por el mismo cliente", param.intervalo);
+    cmd.AddValue ("semilla", "Semilla fija (réplicas reproducibles con run = nº de réplica). 0 usa el PID", semilla);
+    cmd.AddValue ("mRetIni", "MaxRetries inicial", mRetIni);
+    cmd.AddValue ("incMRet", "Incremento de MaxRetries", incMRet);
+    cmd.AddValue ("mRetFin", "MaxRetries final", mRetFin);
+    cmd.AddValue ("adaptativo", "Barrido adaptativo: refina MaxRetries donde más cambian las curvas", adaptativo);
+    cmd.AddValue ("pasoIni", "Barrido adaptativo: separación inicial entre puntos (en incMRet)", pasoIni);
+    cmd.AddValue ("presupuesto", "Barrido adaptativo: réplicas totales (0 para la mitad del barrido uniforme)", presupuesto);
+    cmd.AddValue ("perfil", "Perfil de fidelidad: exacto, rapido o minimo", nombrePerfil);
+    cmd.AddValue ("ab", "Ejecuta también el perfil exacto con las mismas semillas y contrasta la equivalencia", ab);
+    cmd.AddValue ("margenAB", "Margen de equivalencia A/B (fracción de la media del perfil exacto)", margenAB);
+    cmd.AddValue ("nSegmentos", "Segmentos CSMA independientes simulados a la vez en cada proceso hijo", param.nSegmentos);
+    cmd.AddValue ("tVentana", "Duración de las ventanas de la serie temporal de contadores (0 la desactiva)", param.tVentana);
     cmd.Parse (argc,argv);
     NS_LOG_FUNCTION (param.nCsma << param.retardoProp << param.capacidad << param.tamPaquete << param.intervalo);
 
+    const perfil * prf = 0;
+    for (uint32_t i = 0; i < sizeof(PERFILES) / sizeof(PERFILES[0]); ++i)
+    {
+        if (nombrePerfil == PERFILES[i].nombre)
+        {
+            prf = &PERFILES[i];
+        }
+    }
+    NS_ABORT_MSG_IF (prf == 0, "Perfil desconocido: " << nombrePerfil);
+    NS_ABORT_MSG_IF (param.nSegmentos > 253, "nSegmentos=" << param.nSegmentos // Subredes 10.1.(2+k).0/24
+                     << " supera el máximo de 253 segmentos por simulación");
+
+    if (ab && semilla == 0) // El contraste A/B es pareado: necesita semillas comunes en ambos perfiles
+    {
+        semilla = 1;
+    }
+
 
     /*********************** Gráficas ***********************/
     Gnuplot plot_Intentos, plot_Eco, plot_Porcen;                       // 3 gráficas
@@ -115,76 +211,160 @@ main (int argc, char *argv[])
 
 
     /***************** Bucles de simulación *****************/
-    resultados res;
     Average<double> acumSim_Intentos;
-    Average<int64_t> acumSim_Eco;
+    Average<double> acumSim_Eco;
     Average<double> acumSim_Porcen;
     double mediaSim_Intentos, mediaSim_Eco, mediaSim_Porcen, z_Intentos, z_Eco, z_Porcen;
 
     pid_t pid = 1; // Identificador de proceso. También utiliza como variable de control
 
-    for (uint32_t nMaxRetries = MRETINI; pid && nMaxRetries <= MRETFIN; nMaxRetries += INCMRET)
+    uint64_t nEventos = 0;                            // Eventos procesados por todos los hijos (para rendimiento)
+    double tPerfil = 0, tRef = 0;                     // Tiempo real de las réplicas del perfil y del exacto (A/B)
+    uint64_t nEvPerfil = 0, nEvRefTotal = 0;          // Eventos de las réplicas del perfil y del exacto (A/B)
+    double tIni = reloj ();                           // Tiempo real del barrido completo
+
+    std::ofstream fichero_Resumen;                    // Resumen numérico de resultados, para comparar con referencias
+    fichero_Resumen.open("practica05-resumen.txt");
+    fichero_Resumen << "# nMaxRetries mediaIntentos zIntentos mediaEco zEco mediaPorcen zPorcen" << std::endl;
+
+    std::ofstream fichero_Nodos;                      // Resultados por nodo, con IC entre réplicas
+    fichero_Nodos.open("practica05-nodos.txt");
+    fichero_Nodos << "# nMaxRetries nodo mediaIntentos zIntentos mediaEco zEco mediaVarEco mediaPerdidos zPerdidos"
+                  << std::endl;
+
+    AlmacenReplicas almacen(param.nCsma, param.tamPaquete, param.intervalo.GetMicroSeconds(),   // Valores de cada
+                            param.capacidad.GetBitRate(), param.retardoProp.GetNanoSeconds(),  // réplica, para
+                            std::max (param.nSegmentos, 1u));                                  // análisis posteriores
+
+    std::ofstream fichero_AB;                         // Contraste de equivalencia, sólo en modo A/B
+    uint32_t noEquivalentes = 0;
+    uint32_t sinDatos = 0;                            // Contrastes sin pares suficientes (no cuentan como fallidos)
+    if (ab)
+    {
+        fichero_AB.open("practica05-ab.txt");
+        fichero_AB << "# perfil " << prf->nombre << " frente a " << PERFILES[0].nombre << ", margen " << margenAB << std::endl;
+        fichero_AB << "# nMaxRetries metrica mediaExacto difMedia zDif pares equivalente" << std::endl;
+    }
+
+    /*
+        Puntos del eje de abcisas. En el barrido uniforme son todos los de la rejilla mRetIni:incMRet:mRetFin. En el
+      adaptativo se empieza con una rejilla gruesa (pasoIni incrementos, más mRetFin) y, agotada ésta, se añaden de uno
+      en uno los que elige siguientePunto() mientras quede presupuesto de réplicas.
+    */
+    uint32_t repPorPunto = SIMPP * (ab ? 2 : 1);      // Réplicas que cuesta cada punto
+    uint32_t gastadas = 0;
+    uint32_t paso = adaptativo ? pasoIni * incMRet : incMRet;
+    if (adaptativo && presupuesto == 0)
     {
+        presupuesto = repPorPunto * (((mRetFin - mRetIni) / incMRet + 2) / 2);
+    }
+
+    std::vector<uint32_t> pendientes;                 // Puntos por simular, en orden
+    for (uint32_t x = mRetIni; x <= mRetFin; x += paso)
+    {
+        pendientes.push_back(x);
+    }
+    if (adaptativo && !pendientes.empty() && pendientes.back() != mRetFin) // Vacío si mRetIni > mRetFin
+    {
+        pendientes.push_back(mRetFin);
+    }
+    //   La rejilla gruesa se simula entera, así que el presupuesto tiene que cubrirla. Si no, se aborta en lugar de
+    // superarlo sin avisar.
+    NS_ABORT_MSG_IF (adaptativo && pendientes.size() * repPorPunto > presupuesto,
+                     "Presupuesto insuficiente para la rejilla inicial: hacen falta al menos "
+                     << pendientes.size() * repPorPunto << " réplicas (o un pasoIni mayor)");
+    std::map<uint32_t, punto> puntos;                 // Puntos ya simulados, ordenados por MaxRetries
+
+    while (pid && !pendientes.empty())
+    {
+        uint32_t nMaxRetries = pendientes.front();
+        pendientes.erase(pendientes.begin());
+
         NS_LOG_INFO ("\n####################### Simulación para MaxRetries=" << nMaxRetries << " #######################");
 
-        /* 
-            Bucle de simulaciones modificado para el uso de múltiples procesos. Se crean los procesos hijo mediante fork(),
-          se instalan las tuberías y se realiza la simulación en sí por parte de los hijos. También es necesario cambiar
-          la semilla del generador de números aleatorios para obtener resultados válidos.
-        */
-        for (uint32_t i = 0; pid && i < SIMPP; i+=maxProc)
-        {
-            uint32_t nProc = maxProc; // Número de hilos en cada iteración.
+        resultados res[SIMPP];                        // Resultados de cada réplica del punto
+        resultadosNodo nodos[SIMPP * param.nCsma];    // Y de cada nodo: nodos[réplica * nCsma + nodo]
+        uint64_t nEvPunto;
+        double t0 = reloj ();
+        pid = replicas(nMaxRetries, &param, prf, maxProc, semilla, res, nodos, &nEvPunto);
+        tPerfil += reloj () - t0;
 
-            // Si las simulaciones que quedan son menos que maxProc...
-            if (SIMPP - i < maxProc)
+        if (pid && ab)
+        {
+            /****** Modo A/B: mismo punto y semillas con el perfil exacto ******/
+            resultados resRef[SIMPP];
+            uint64_t nEvRef;
+            t0 = reloj ();
+            pid = replicas(nMaxRetries, &param, &PERFILES[0], maxProc, semilla, resRef, 0, &nEvRef); // Sin nodos
+            tRef += reloj () - t0;
+            nEvRefTotal += pid ? nEvRef : 0;
+            nEventos    += pid ? nEvRef : 0;          // tReal incluye estas réplicas: sus eventos también cuentan
+
+            for (uint32_t r = 0; pid && r < SIMPP; ++r)
             {
-                nProc = SIMPP - i;
+                almacen.Anade(nMaxRetries, 0, resRef[r].semilla, resRef[r].run, resRef[r].segmento,
+                              resRef[r].nMediaIntentos, ecoUs(resRef[r]), resRef[r].porcenPaqTxCorrect);
             }
 
-            int tuberia[nProc][2];                                      // Tabla con los descriptores de cada tubería
-            for (uint32_t p = 0; pid && p < nProc; ++p)
+            //   Métricas comparables: intentos y porcentaje de correctos siempre; tiempo de eco si el perfil lo mide.
+            // Se contrastan las diferencias pareadas réplica a réplica (semillas comunes).
+            double ref[3][SIMPP], prueba[3][SIMPP];
+            const char * metrica[3] = { "Intentos", "Eco", "Porcen" };
+            for (uint32_t r = 0; pid && r < SIMPP; ++r)
+            {
+                ref[0][r] = resRef[r].nMediaIntentos;                prueba[0][r] = res[r].nMediaIntentos;
+                ref[1][r] = ecoUs(resRef[r]);                        prueba[1][r] = ecoUs(res[r]);
+                ref[2][r] = resRef[r].porcenPaqTxCorrect;            prueba[2][r] = res[r].porcenPaqTxCorrect;
+            }
+            for (uint32_t m = 0; pid && m < 3; ++m)
             {
-                pipe (tuberia[p]);                                      // Creación de tubería
-                pid = fork ();                                          // Creación de proceso hijo
-                if (pid == 0) // Proceso hijo
+                if (m == 1 && !prf->metricaEco)
                 {
-                    ns3::RngSeedManager::SetSeed( (uint32_t) getpid()); // Nueva semilla del generador: PID del hijo
-                    res = simulacion(nMaxRetries, &param);              // Llamada a simulacion
-                    close(tuberia[p][LEC]);
-                    write(tuberia[p][ESC], &res, sizeof(res));          // Envío de resultados al proceso padre
-                    close(tuberia[p][ESC]);
+                    continue;
                 }
-                else // Proceso padre
+                double mediaRef, difMedia, z;
+                uint32_t nPares;
+                bool equiv = equivalentes(ref[m], prueba[m], margenAB, &mediaRef, &difMedia, &z, &nPares);
+                fichero_AB << nMaxRetries << " " << metrica[m] << " " << mediaRef << " " << difMedia << " " << z << " "
+                           << nPares << " ";
+                if (nPares < 2)                                // Sin IC posible: ni equivalente ni fallido
                 {
-                    close (tuberia[p][ESC]);
+                    sinDatos++;
+                    fichero_AB << "insuficiente" << std::endl;
+                    NS_LOG_INFO ("A/B " << metrica[m] << ": datos insuficientes (" << nPares << " pares)");
+                    continue;
                 }
+                noEquivalentes += !equiv;
+                fichero_AB << equiv << std::endl;
+                NS_LOG_INFO ("A/B " << metrica[m] << ": dif. media " << difMedia << " +- " << z
+                             << (equiv ? " (equivalente)" : " (NO equivalente)"));
             }
+        }
 
-
-            for (uint32_t p = 0; pid && p < nProc; ++p)
+        if (pid)
+        {
+            nEventos  += nEvPunto;
+            nEvPerfil += nEvPunto;
+            for (uint32_t r = 0; r < SIMPP; ++r)
             {
-                read(tuberia[p][LEC],&res,sizeof(res));                 // Recepción de resultados enviados por el hijo
+                acumSim_Intentos.Update(res[r].nMediaIntentos);                // Actualización de acumuladores
+                if (ecoUs(res[r]) == ecoUs(res[r]))                    // Sin medida de eco (NaN) no cuenta
+                {
+                    acumSim_Eco.Update(ecoUs(res[r]));
+                }
+                acumSim_Porcen.Update(res[r].porcenPaqTxCorrect);
 
-                acumSim_Intentos.Update(res.nMediaIntentos);            // Actualización de acumuladores
-                acumSim_Eco.Update(res.tMediaEco.GetMicroSeconds());
-                acumSim_Porcen.Update(res.porcenPaqTxCorrect);
+                almacen.Anade(nMaxRetries, prf - PERFILES, res[r].semilla, res[r].run, res[r].segmento,
+                              res[r].nMediaIntentos, ecoUs(res[r]), res[r].porcenPaqTxCorrect);
             }
 
-
-
-        }
-
-
-        if (pid)
-        {
             /*********** Cálculo del IC_0.95 de la medias ***********/
             mediaSim_Intentos = acumSim_Intentos.Mean();                     // Cálculo de medias
-            mediaSim_Eco      = acumSim_Eco.Mean();
+            mediaSim_Eco      = acumSim_Eco.Count() ? acumSim_Eco.Mean() : NAN; // NaN si no se mide (perfil minimo)
             mediaSim_Porcen   = acumSim_Porcen.Mean();
 
             z_Intentos        = T_14_025*sqrt(acumSim_Intentos.Var()/SIMPP); // .Var() devuelve la Cuasivarianza.
-            z_Eco             = T_14_025*sqrt(acumSim_Eco.Var()/SIMPP);
+            z_Eco             = semiamplitud(acumSim_Eco);                   // Puede haber menos de SIMPP réplicas
             z_Porcen          = T_14_025*sqrt(acumSim_Porcen.Var()/SIMPP);
 
             acumSim_Intentos.Reset();                                        // Dejar listos para siguiente simulación
@@ -195,15 +375,65 @@ main (int argc, char *argv[])
             NS_LOG_INFO ("Tiempo de eco: IC_0.95: [ " << mediaSim_Eco - z_Eco << " , " << mediaSim_Eco + z_Eco << " ]");
             NS_LOG_INFO ("Porcentaje Correctos: IC_0.95: [ " << mediaSim_Porcen - z_Porcen << " , " << mediaSim_Porcen + z_Porcen << " ]");
 
-            //            .Add(x, y, error)
-            datos_Intentos.Add(nMaxRetries, mediaSim_Intentos, z_Intentos);
-            datos_Eco.Add(nMaxRetries, mediaSim_Eco, z_Eco);
-            datos_Porcen.Add(nMaxRetries, mediaSim_Porcen, z_Porcen);
+            punto pto = { { mediaSim_Intentos, mediaSim_Eco, mediaSim_Porcen }, { z_Intentos, z_Eco, z_Porcen } };
+            puntos[nMaxRetries] = pto;
+
+            resumenNodos(fichero_Nodos, nMaxRetries, param.nCsma, nodos);
+
+            gastadas += repPorPunto;
+            uint32_t siguiente;
+            if (adaptativo && pendientes.empty() && gastadas + repPorPunto <= presupuesto
+                && siguientePunto(puntos, incMRet, prf->metricaEco, &siguiente))
+            {
+                pendientes.push_back(siguiente);
+            }
         }
     }
 
     if (pid) // Es el padre
     {
+        // Gráficas y resumen, en orden de MaxRetries aunque el barrido adaptativo no los haya simulado en orden
+        for (std::map<uint32_t, punto>::iterator it = puntos.begin(); it != puntos.end(); ++it)
+        {
+            punto & pto = it->second;
+
+            //            .Add(x, y, error)
+            datos_Intentos.Add(it->first, pto.media[0], pto.z[0]);
+            if (prf->metricaEco) // Con el perfil minimo no se mide
+            {
+                datos_Eco.Add(it->first, pto.media[1], pto.z[1]);
+            }
+            datos_Porcen.Add(it->first, pto.media[2], pto.z[2]);
+
+            fichero_Resumen << it->first << " " << pto.media[0] << " " << pto.z[0] << " "
+                            << pto.media[1] << " " << pto.z[1] << " " << pto.media[2] << " " << pto.z[2] << std::endl;
+        }
+
+        if (!almacen.Escribe("practica05-replicas.col"))
+        {
+            std::cerr << "Error al escribir practica05-replicas.col" << std::endl;
+        }
+
+        /****************** Rendimiento del barrido ******************/
+        double tReal = reloj () - tIni;
+        fichero_Resumen << "# tiempo " << tReal << " eventos " << nEventos
+                        << " eventosPorSegundo " << nEventos / tReal << " replicas " << gastadas << std::endl;
+        fichero_Resumen.close();
+        fichero_Nodos.close();
+        NS_LOG_INFO ("Tiempo real: " << tReal << " s, eventos: " << nEventos << ", eventos/s: " << nEventos / tReal);
+
+        if (ab)
+        {
+            fichero_AB << "# tiempo " << prf->nombre << " " << tPerfil << " " << PERFILES[0].nombre << " " << tRef
+                       << " aceleracion " << tRef / tPerfil << std::endl;
+            fichero_AB << "# eventosPorSegundo " << prf->nombre << " " << nEvPerfil / tPerfil << " "
+                       << PERFILES[0].nombre << " " << nEvRefTotal / tRef << std::endl;
+            fichero_AB.close();
+            std::cout << "A/B: perfil " << prf->nombre << (noEquivalentes ? " NO equivalente" : " equivalente")
+                      << " a " << PERFILES[0].nombre << " (" << noEquivalentes << " contrastes fallidos, " << sinDatos
+                      << " sin datos suficientes, margen " << margenAB << "). Aceleración: " << tRef / tPerfil << std::endl;
+        }
+
         /****************** Dibujo de gráficas ******************/
         plot_Intentos.AddDataset(datos_Intentos);
         std::ofstream fichero_Intentos("practica05-01.plt");
@@ -211,11 +441,18 @@ main (int argc, char *argv[])
         fichero_Intentos << "pause -1" << std::endl;
         fichero_Intentos.close();
 
-        plot_Eco.AddDataset(datos_Eco);
-        std::ofstream fichero_Eco("practica05-02.plt");
-        plot_Eco.GenerateOutput(fichero_Eco);
-        fichero_Eco << "pause -1" << std::endl;
-        fichero_Eco.close();
+        if (prf->metricaEco) // Sin datos, gnuplot no podría dibujarla: con el perfil minimo no se genera
+        {
+            plot_Eco.AddDataset(datos_Eco);
+            std::ofstream fichero_Eco("practica05-02.plt");
+            plot_Eco.GenerateOutput(fichero_Eco);
+            fichero_Eco << "pause -1" << std::endl;
+            fichero_Eco.close();
+        }
+        else
+        {
+            unlink("practica05-02.plt");                  // La de un barrido anterior no corresponde a éste
+        }
 
         plot_Porcen.AddDataset(datos_Porcen);
         std::ofstream fichero_Porcen("practica05-03.plt");
@@ -233,80 +470,239 @@ main (int argc, char *argv[])
 
 
 
-resultados
-simulacion (uint32_t nMaxRetries, parametros * param)
+pid_t
+replicas (uint32_t nMaxRetries, parametros * param, const perfil * prf, uint32_t maxProc, uint32_t semilla,
+          resultados * res, resultadosNodo * nodos, uint64_t * nEventos)
 {
-    NS_LOG_FUNCTION (nMaxRetries); // Sólo con el argumento que es variable
+    NS_LOG_FUNCTION (nMaxRetries << prf->nombre << maxProc << semilla);
     /*
-        Función donde se programa la gestión principal de una simulación simple.
+        Bucle de simulaciones modificado para el uso de múltiples procesos. Se crean los procesos hijo mediante fork(),
+      se instalan las tuberías y se realiza la simulación en sí por parte de los hijos. También es necesario cambiar
+      la semilla del generador de números aleatorios para obtener resultados válidos.
+
+        Cada hijo simula nSeg segmentos independientes en un único Simulator, y cada segmento se cuenta como una
+      réplica. Así el coste fijo de cada proceso (fork, inicialización de ns-3, Simulator::Destroy) se reparte.
+
+        En el padre deja los SIMPP resultados en res (en orden de réplica), los de cada nodo en nodos (réplica a
+      réplica, nCsma por réplica) y los eventos procesados en nEventos, y devuelve un valor distinto de 0. En los hijos
+      devuelve 0, para que terminen sin seguir el barrido.
+
+        Cada hijo envía un único bloque binario: sus resultados agregados, los de cada nodo y sus eventos. Si nodos es
+      0 (p.ej. réplicas de referencia del modo A/B) los resultados por nodo ni se envían ni se leen.
     */
-    
-    uint32_t nCsma = param->nCsma; // Variable auxiliar
+
+    pid_t pid = 1;
+    uint32_t nSeg = std::max (param->nSegmentos, 1u); // Segmentos CSMA (réplicas) por simulación
+    uint32_t nCsma = param->nCsma;
+    *nEventos = 0;
+
+    for (uint32_t i = 0; pid && i < SIMPP; i += maxProc * nSeg)
+    {
+        uint32_t nProc = maxProc; // Número de hilos en cada iteración.
+
+        // Si las simulaciones que quedan no llenan maxProc procesos de nSeg segmentos...
+        if (SIMPP - i < maxProc * nSeg)
+        {
+            nProc = (SIMPP - i + nSeg - 1) / nSeg;
+        }
+
+        int tuberia[nProc][2];                                      // Tabla con los descriptores de cada tubería
+        uint32_t segProc[nProc];                                    // Réplicas (segmentos) que simula cada hijo
+        for (uint32_t p = 0; pid && p < nProc; ++p)
+        {
+            segProc[p] = std::min (nSeg, SIMPP - i - p * nSeg);    // El último hijo puede llevar menos segmentos
+
+            pipe (tuberia[p]);                                      // Creación de tubería
+            pid = fork ();                                          // Creación de proceso hijo
+            if (pid == 0) // Proceso hijo
+            {
+                if (semilla == 0)
+                {
+                    ns3::RngSeedManager::SetSeed( (uint32_t) getpid()); // Nueva semilla del generador: PID del hijo
+                }
+                else // Réplicas reproducibles: misma semilla, un run distinto por réplica
+                {
+                    ns3::RngSeedManager::SetSeed(semilla);
+                    ns3::RngSeedManager::SetRun(1 + i + p * nSeg);
+                }
+                GlobalValue::Bind("ChecksumEnabled", BooleanValue(prf->checksum)); // Cada hijo, su perfil
+
+                uint32_t r = i + p * nSeg;                          // Primera réplica del hijo
+                std::vector<resultadosNodo> nodosHijo(segProc[p] * nCsma);
+                uint64_t nEvHijo = simulacion(nMaxRetries, param, prf, segProc[p], &res[r], &nodosHijo[0]);
+                close(tuberia[p][LEC]);
+                write(tuberia[p][ESC], &res[r], segProc[p] * sizeof(resultados)); // Envío al padre
+                if (nodos)
+                {
+                    write(tuberia[p][ESC], &nodosHijo[0], nodosHijo.size() * sizeof(resultadosNodo));
+                }
+                write(tuberia[p][ESC], &nEvHijo, sizeof(nEvHijo));  // Seguido de los eventos procesados
+                close(tuberia[p][ESC]);
+            }
+            else // Proceso padre
+            {
+                close (tuberia[p][ESC]);
+            }
+        }
+
+
+        for (uint32_t p = 0; pid && p < nProc; ++p)
+        {
+            uint32_t r = i + p * nSeg;
+            uint64_t nEvHijo;
+            leeCompleto(tuberia[p][LEC], &res[r], segProc[p] * sizeof(resultados)); // Resultados del hijo
+            if (nodos)
+            {
+                leeCompleto(tuberia[p][LEC], &nodos[r * nCsma], segProc[p] * nCsma * sizeof(resultadosNodo));
+            }
+            leeCompleto(tuberia[p][LEC], &nEvHijo, sizeof(nEvHijo));
+            close(tuberia[p][LEC]);
+            *nEventos += nEvHijo;
+        }
+    }
+
+    return pid;
+}
+
 
 
-    /******** Montaje y configuración de la topología *******/
-    NodeContainer csmaNodes;
-    csmaNodes.Create (nCsma);
 
-    CsmaHelper csma;
-    csma.SetChannelAttribute ("DataRate", DataRateValue (param->capacidad));
-    csma.SetChannelAttribute ("Delay", TimeValue (param->retardoProp));
 
-    NetDeviceContainer csmaDevices;
-    csmaDevices = csma.Install (csmaNodes);
-    // Configuramos parámetros de backoff en todos los nodos del escenario
-    for (uint32_t i = 0; i < nCsma; ++i)
+
+
+void
+leeCompleto (int descriptor, void * buffer, size_t tam)
+{
+    /*
+        Lectura de tam bytes de una tubería. read() puede devolver menos de lo pedido cuando el bloque supera la
+      capacidad atómica de la tubería (los resultados por nodo crecen con nCsma y nSegmentos), así que se repite hasta
+      completar. Si el hijo termina antes (read devuelve 0 o error) se deja de leer.
+    */
+
+    char * destino = (char *) buffer;
+    while (tam > 0)
     {
-        //                  Conv. del obj. devuelto     SetBackoffParams (slotTime, minSlots, maxSlots, ceiling, MaxRetries)
-        csmaDevices.Get(i)->GetObject<CsmaNetDevice>()->SetBackoffParams (Time ("1us"), 10, 1000, 10, nMaxRetries);
+        ssize_t leidos = read(descriptor, destino, tam);
+        if (leidos <= 0)
+        {
+            return;
+        }
+        destino += leidos;
+        tam     -= leidos;
     }
-    // Instalamos la pila TCP/IP en todos los nodos
-    InternetStackHelper stack;
-    stack.Install (csmaNodes);
-    // Y les asignamos direcciones
-    Ipv4AddressHelper address;
-    address.SetBase ("10.1.2.0", "255.255.255.0");
-    Ipv4InterfaceContainer csmaInterfaces = address.Assign (csmaDevices);
+}
 
-    /////////// Instalación de las aplicaciones
-    // Servidor
-    UdpEchoServerHelper echoServer (9); // Puerto de escucha del servidor (9).
-    ApplicationContainer serverApp = echoServer.Install (csmaNodes.Get (nCsma - 1)); // El servidor es el último
-    serverApp.Start (Seconds (1.0));
-    serverApp.Stop (Seconds (TSTOP));
-    // Clientes
-    UdpEchoClientHelper echoClient (csmaInterfaces.GetAddress (nCsma - 1), 9); // IP_dest (Servidor), Pto_dest (9)
-    echoClient.SetAttribute ("MaxPackets", UintegerValue (10000));
-    echoClient.SetAttribute ("Interval", TimeValue (param->intervalo));
-    echoClient.SetAttribute ("PacketSize", UintegerValue (param->tamPaquete)); // + 8 (UDP) + 20 (IP) + 18 (Eth) + 2 (Phy)?
-    NodeContainer clientes;
-    for (uint32_t i = 0; i < nCsma - 1; i++)
+
+
+
+
+
+
+void
+resumenNodos (std::ostream & salida, uint32_t nMaxRetries, uint32_t nCsma, resultadosNodo * nodos)
+{
+    NS_LOG_FUNCTION (nMaxRetries << nCsma);
+    /*
+        Escribe, para cada nodo, la media entre réplicas de sus resultados y el IC_0.95 de intentos, tiempo de eco y
+      porcentaje de perdidos. Sustituye a los NS_LOG_DEBUG por nodo, que obligaban a repetir el barrido con logs.
+
+        Como en el Observador, una réplica en la que el nodo no midió nada (NaN) no cuenta para su media. Por eso el
+      número de réplicas de cada nodo puede ser menor que SIMPP y el IC usa la t con Count()-1 grados de libertad.
+    */
+
+    for (uint32_t n = 0; n < nCsma; ++n)
     {
-        clientes.Add (csmaNodes.Get (i));
+        Average<double> acumIntentos, acumEco, acumVarEco, acumPerdidos;
+        for (uint32_t r = 0; r < SIMPP; ++r)
+        {
+            resultadosNodo * nodo = &nodos[r * nCsma + n];
+            if (nodo->intentos == nodo->intentos)             // Si no es NaN...
+            {
+                acumIntentos.Update(nodo->intentos);
+            }
+            if (nodo->mediaEco == nodo->mediaEco)
+            {
+                acumEco.Update(nodo->mediaEco);
+            }
+            if (nodo->varEco == nodo->varEco)
+            {
+                acumVarEco.Update(nodo->varEco);
+            }
+            if (nodo->porcenPerdidos == nodo->porcenPerdidos)
+            {
+                acumPerdidos.Update(nodo->porcenPerdidos);
+            }
+        }
+
+        salida << nMaxRetries << " " << n << " "
+               << acumIntentos.Mean() << " " << semiamplitud(acumIntentos) << " "
+               << acumEco.Mean() << " " << semiamplitud(acumEco) << " "
+               << acumVarEco.Mean() << " "
+               << acumPerdidos.Mean() << " " << semiamplitud(acumPerdidos) << "\n";
     }
-    ApplicationContainer clientApps = echoClient.Install (clientes);
-    clientApps.Start (Seconds (2.0));
-    clientApps.Stop (Seconds (TSTOP));
+    salida.flush(); // Antes del siguiente fork, para que los hijos no hereden datos sin volcar
+}
 
-    // Cálculo de rutas
-    Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
 
+double
+semiamplitud (Average<double> & acum)
+{
+    /*
+        Semiamplitud del IC_0.95 de la media de acum, con t de Count()-1 grados de libertad. NaN si hay menos de dos
+      valores.
+    */
 
-    /************ Captura de datos de simulación ************/
-    Observador observador(&csmaDevices); // Un único observador que obtiene datos de todos los nodos de la topología
-    // csma.EnablePcap ("practica05", csmaDevices.Get (nCsma - 1), true); // Se comenta tras terminar la depuración
+    if (acum.Count() < 2)
+    {
+        return NAN;
+    }
 
-    Simulator::Run ();
-    Simulator::Destroy ();
+    return tStudent(acum.Count() - 1) * sqrt(acum.Var() / acum.Count());
+}
 
-    logsDebug(nCsma, &observador); // Impresión de NS_LOG_DEBUG
 
-    resultados res = {             // Devolución de valores como estructura. Se excluye el nodo 0 y el servidor nCsma-1
-        .nMediaIntentos = observador.MediaIntentos (1, nCsma-2),
-        .tMediaEco = observador.MediaEco (1, nCsma-2),  
-        .porcenPaqTxCorrect = 100.0 - observador.PorcenPaqPerdidos (1, nCsma-2) // Correc % = 100 - Perdidos %
-    };
-    return res;
+
+
+
+
+
+bool
+equivalentes (double * ref, double * prueba, double margen, double * mediaRef, double * difMedia, double * z,
+              uint32_t * nPares)
+{
+    NS_LOG_FUNCTION (margen);
+    /*
+        Contraste de equivalencia (TOST, dos contrastes unilaterales al 5%) entre las SIMPP réplicas de referencia y
+      las de prueba, obtenidas con las mismas semillas. Al ser pareadas se trabaja con las diferencias réplica a
+      réplica, lo que elimina la variabilidad común.
+
+        Son equivalentes si el IC_0.90 de la diferencia media, [dif - z , dif + z], cae dentro de
+      [-margen*|mediaRef| , +margen*|mediaRef|].
+
+        Si el perfil no cambia el consumo de números aleatorios (p.ej. sólo quita checksums), las diferencias son
+      nulas y el contraste se supera trivialmente, como debe ser.
+
+        Los pares en los que alguna de las dos réplicas no tiene medida (NaN, p.ej. ningún eco completado) se
+      descartan, y la t usa los grados de libertad de los pares restantes, que se devuelven en nPares. Con menos de
+      dos no hay IC: z es NaN y el resultado no es significativo.
+    */
+
+    Average<double> acumRef, acumDif;
+    for (uint32_t r = 0; r < SIMPP; ++r)
+    {
+        if (ref[r] == ref[r] && prueba[r] == prueba[r])     // Si ninguno es NaN...
+        {
+            acumRef.Update(ref[r]);
+            acumDif.Update(prueba[r] - ref[r]);
+        }
+    }
+
+    *nPares   = acumDif.Count();
+    *mediaRef = acumRef.Mean();
+    *difMedia = acumDif.Mean();
+    *z        = *nPares < 2 ? NAN : tStudent05(*nPares - 1)*sqrt(acumDif.Var()/ *nPares);
+
+    return std::fabs(*difMedia) + *z <= margen * std::fabs(*mediaRef);
 }
 
 
@@ -315,35 +711,259 @@ simulacion (uint32_t nMaxRetries, parametros * param)
 
 
 
-void
-logsDebug (uint32_t nCsma, Observador * observador)
+bool
+siguientePunto (std::map<uint32_t, punto> & puntos, uint32_t incMRet, bool metricaEco, uint32_t * siguiente)
 {
-    NS_LOG_FUNCTION_NOARGS (); // No nos interesa ningún argumento
+    NS_LOG_FUNCTION (puntos.size() << incMRet);
     /*
-        Si se solicita (ajustando la variable de entorno NS_LOG con practica05=level_debug o superior), se mostrarán
-      resultados acerca de la simulación.
+        Elige el siguiente punto del barrido adaptativo: el punto medio (en la rejilla de incMRet) del intervalo entre
+      dos puntos ya simulados en el que más cambian las curvas.
+
+        Para cada métrica se normaliza el cambio entre extremos del intervalo por el rango de la métrica en todo el
+      barrido, para poder comparar intentos, microsegundos y porcentajes. Si los IC de los extremos se solapan, el
+      cambio real no está resuelto y se toma como cambio posible la suma de semiamplitudes: así se refina también donde
+      la curva aún no se distingue del ruido. La puntuación del intervalo es la máxima de sus métricas.
+
+        Devuelve false si ya no hay intervalos divisibles (todos los puntos de la rejilla están simulados).
     */
 
-    // Número medio de intentos
-    for (uint32_t i = 0; i < nCsma -1; ++i) // Valor medio para cada cliente (servidor no)
+    double minimo[3], maximo[3];
+    for (uint32_t m = 0; m < 3; ++m)
+    {
+        minimo[m] = INFINITY;
+        maximo[m] = -INFINITY;
+    }
+    for (std::map<uint32_t, punto>::iterator it = puntos.begin(); it != puntos.end(); ++it)
     {
-        NS_LOG_DEBUG ("NODO " << i << " - Intentos promedio por paquete: " << observador->MediaIntentos(i) );
+        for (uint32_t m = 0; m < 3; ++m)
+        {
+            minimo[m] = std::min(minimo[m], it->second.media[m]);
+            maximo[m] = std::max(maximo[m], it->second.media[m]);
+        }
     }
-    // NS_LOG_INFO("NODO Servidor - Intentos promedio por paquete: " << observador->MediaIntentos(nCsma -1) );
-    NS_LOG_DEBUG ("Intentos promedio por paquete en la topología: " << observador->MediaIntentos(0,nCsma-1) << "\n" );
 
-    // Tiempo medio de eco
-    for (uint32_t i = 0; i < nCsma -1; ++i) // Valor medio para cada cliente (servidor no)
+    double mejor = -1;                                // Puntuación del mejor intervalo encontrado
+    std::map<uint32_t, punto>::iterator b = puntos.begin();
+    std::map<uint32_t, punto>::iterator a = b++;
+    for (; b != puntos.end(); ++a, ++b)
     {
-        NS_LOG_DEBUG ("NODO " << i << " - Tiempo medio de eco: " << observador->MediaEco(i) );
+        uint32_t huecos = (b->first - a->first) / incMRet;
+        if (huecos < 2) // Intervalo ya sin puntos intermedios
+        {
+            continue;
+        }
+
+        double puntuacion = 0;
+        for (uint32_t m = 0; m < 3; ++m)
+        {
+            double rango = maximo[m] - minimo[m];
+            if ((m == 1 && !metricaEco) || !(rango > 0)) // Métrica no medida o curva plana en todo el barrido
+            {
+                continue;
+            }
+            double cambio = std::fabs(b->second.media[m] - a->second.media[m]);
+            double solape = a->second.z[m] + b->second.z[m];
+            puntuacion = std::max(puntuacion, std::max(cambio, solape) / rango);
+        }
+
+        if (puntuacion > mejor)
+        {
+            mejor      = puntuacion;
+            *siguiente = a->first + (huecos / 2) * incMRet;
+        }
     }
-    NS_LOG_DEBUG ("Tiempo medio de eco de todos los clientes: " << observador->MediaEco(0,nCsma-2) << "\n" );
 
-    // Porcentaje de paquetes perdidos
-    for (uint32_t i = 0; i < nCsma; ++i) // Porcentaje para cada nodo
+    if (mejor < 0)
     {
-        NS_LOG_DEBUG ("NODO " << i << " - Porcentaje de paquetes perdidos: " << observador->PorcenPaqPerdidos(i) << "%" );
+        NS_LOG_INFO ("Barrido adaptativo: sin intervalos divisibles");
+        return false;
     }
-    NS_LOG_DEBUG ("Porcentaje de paquetes perdidos de todos los clientes: " << observador->PorcenPaqPerdidos(0,nCsma-2) << "%" );
-    NS_LOG_DEBUG ("Porcentaje de paquetes perdidos de la topología: " << observador->PorcenPaqPerdidos(0,nCsma-1) << "%" << "\n" );
+
+    NS_LOG_INFO ("Barrido adaptativo: siguiente punto " << *siguiente << " (puntuación " << mejor << ")");
+    return true;
+}
+
+
+
+
+
+
+
+double
+ecoUs (const resultados & res)
+{
+    /*
+        Tiempo medio de eco de una réplica en us, o NaN si no se midió (perfil sin métrica de eco, o ningún eco
+      completado: el Observador lo indica con un Time negativo). Así no se cuela como medida en medias ni almacén.
+    */
+
+    return res.tMediaEco.IsNegative() ? NAN : (double) res.tMediaEco.GetMicroSeconds();
+}
+
+
+
+
+
+
+
+double
+reloj ()
+{
+    /*
+        Tiempo real (no simulado) en segundos, para medir el rendimiento de los barridos.
+    */
+
+    struct timeval t;
+    gettimeofday (&t, 0);
+
+    return t.tv_sec + t.tv_usec / 1e6;
+}
+
+
+
+
+
+
+
+uint64_t
+simulacion (uint32_t nMaxRetries, parametros * param, const perfil * prf, uint32_t nSegmentos, resultados * res,
+            resultadosNodo * nodos)
+{
+    NS_LOG_FUNCTION (nMaxRetries << prf->nombre << nSegmentos); // Sólo con los argumentos que son variables
+    /*
+        Función donde se programa la gestión principal de una simulación simple.
+
+        Se montan nSegmentos segmentos CSMA disjuntos (cada uno con su canal, su servidor de eco, sus flujos del
+      generador aleatorio y su Observador) dentro del mismo Simulator. Los resultados de cada segmento son una réplica
+      independiente y se devuelven en res[0..nSegmentos-1]. Los resultados de cada nodo del segmento k quedan en
+      nodos[k*nCsma .. k*nCsma + nCsma-1].
+
+        Devuelve el número de eventos procesados por el planificador, para medir el rendimiento.
+
+        Cada segmento usa la subred 10.1.(2+k).0/24, por lo que se admiten hasta 253 segmentos.
+    */
+    
+    uint32_t nCsma = param->nCsma; // Variable auxiliar
+
+    CsmaHelper csma;
+    csma.SetChannelAttribute ("DataRate", DataRateValue (param->capacidad));
+    csma.SetChannelAttribute ("Delay", TimeValue (param->retardoProp));
+
+    InternetStackHelper stack;
+    Ipv4AddressHelper address;
+
+    UdpEchoServerHelper echoServer (9); // Puerto de escucha del servidor (9).
+
+    int64_t flujo = 0;                                // Siguiente flujo del generador aleatorio libre
+    std::vector<NetDeviceContainer> csmaDevices(nSegmentos); // Dispositivos de cada segmento (para los observadores)
+
+    for (uint32_t k = 0; k < nSegmentos; ++k)
+    {
+        /******** Montaje y configuración de la topología *******/
+        NodeContainer csmaNodes;
+        csmaNodes.Create (nCsma);
+
+        csmaDevices[k] = csma.Install (csmaNodes);  // Cada Install crea un canal nuevo: segmentos disjuntos
+        // Configuramos parámetros de backoff en todos los nodos del escenario
+        for (uint32_t i = 0; i < nCsma; ++i)
+        {
+            //                  Conv. del obj. devuelto     SetBackoffParams (slotTime, minSlots, maxSlots, ceiling, MaxRetries)
+            csmaDevices[k].Get(i)->GetObject<CsmaNetDevice>()->SetBackoffParams (Time ("1us"), 10, 1000, 10, nMaxRetries);
+        }
+        // Instalamos la pila TCP/IP en todos los nodos
+        stack.Install (csmaNodes);
+        // Flujos aleatorios propios del segmento, para que los backoffs de distintos segmentos no estén correlados
+        flujo += csma.AssignStreams (csmaDevices[k], flujo);
+        flujo += stack.AssignStreams (csmaNodes, flujo);
+        // Y les asignamos direcciones
+        std::ostringstream subred;
+        subred << "10.1." << 2 + k << ".0";
+        address.SetBase (subred.str().c_str(), "255.255.255.0");
+        Ipv4InterfaceContainer csmaInterfaces = address.Assign (csmaDevices[k]);
+
+        /////////// Instalación de las aplicaciones
+        // Servidor
+        ApplicationContainer serverApp = echoServer.Install (csmaNodes.Get (nCsma - 1)); // El servidor es el último
+        serverApp.Start (Seconds (1.0));
+        serverApp.Stop (Seconds (TSTOP));
+        // Clientes
+        UdpEchoClientHelper echoClient (csmaInterfaces.GetAddress (nCsma - 1), 9); // IP_dest (Servidor), Pto_dest (9)
+        echoClient.SetAttribute ("MaxPackets", UintegerValue (10000));
+        echoClient.SetAttribute ("Interval", TimeValue (param->intervalo));
+        echoClient.SetAttribute ("PacketSize", UintegerValue (param->tamPaquete)); // + 8 (UDP) + 20 (IP) + 18 (Eth) + 2 (Phy)?
+        NodeContainer clientes;
+        for (uint32_t i = 0; i < nCsma - 1; i++)
+        {
+            clientes.Add (csmaNodes.Get (i));
+        }
+        ApplicationContainer clientApps = echoClient.Install (clientes);
+        clientApps.Start (Seconds (2.0));
+        clientApps.Stop (Seconds (TSTOP));
+    }
+
+    // Cálculo de rutas
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+
+    /************ Captura de datos de simulación ************/
+    //   Un observador por segmento que obtiene datos de todos los nodos de su topología. No son copiables (gestionan
+    // memoria propia), por eso se guardan como unique_ptr y se destruyen al salir de la función.
+    std::vector<std::unique_ptr<Observador> > observadores(nSegmentos);
+    for (uint32_t k = 0; k < nSegmentos; ++k)
+    {
+        observadores[k].reset (new Observador(&csmaDevices[k], prf->metricaEco));
+    }
+    // csma.EnablePcap ("practica05", csmaDevices[0].Get (nCsma - 1), true); // Se comenta tras terminar la depuración
+
+    //   Serie temporal por ventanas (opcional). Un fichero CSV por réplica, identificado por perfil, MaxRetries, semilla,
+    // run y segmento, para poder elegir el transitorio y TSTOP viendo cuándo se estabilizan colisiones y descartes.
+    // Con semilla fija todos los hijos comparten semilla y sólo el run los distingue; el perfil separa las réplicas
+    // del modo A/B, que repiten semilla y run.
+    std::vector<std::ofstream> ficheros_Ventanas;
+    if (param->tVentana.IsStrictlyPositive())
+    {
+        ficheros_Ventanas.resize (nSegmentos);
+        for (uint32_t k = 0; k < nSegmentos; ++k)
+        {
+            std::ostringstream nombre;
+            nombre << "practica05-ventanas-" << prf->nombre << "-mr" << nMaxRetries << "-s" << RngSeedManager::GetSeed()
+                   << "-r" << RngSeedManager::GetRun() << "-g" << k << ".csv";
+            ficheros_Ventanas[k].open(nombre.str().c_str());
+            observadores[k]->ActivarVentanas(param->tVentana, Seconds (TSTOP), CAPVENT, &ficheros_Ventanas[k]);
+        }
+    }
+
+    Simulator::Run ();
+    for (uint32_t k = 0; k < nSegmentos; ++k)
+    {
+        observadores[k]->FinalizarVentanas ();
+    }
+    uint64_t nEventos = Simulator::GetEventCount ();
+    Simulator::Destroy ();
+    ficheros_Ventanas.clear ();
+
+    for (uint32_t k = 0; k < nSegmentos; ++k)
+    {
+        // Resultados por nodo, sin pasar por logs. El servidor (nCsma-1) no mide tiempos de eco
+        for (uint32_t i = 0; i < nCsma; ++i)
+        {
+            resultadosNodo * nodo = &nodos[k * nCsma + i];
+            Time mediaEco = observadores[k]->MediaEco (i);
+
+            nodo->intentos       = observadores[k]->MediaIntentos (i);
+            nodo->mediaEco       = (i == nCsma-1 || !prf->metricaEco || mediaEco.IsNegative()) ? NAN : mediaEco.GetMicroSeconds();
+            nodo->varEco         = (i == nCsma-1 || !prf->metricaEco) ? NAN : observadores[k]->VarianzaEco (i);
+            nodo->porcenPerdidos = observadores[k]->PorcenPaqPerdidos (i);
+        }
+
+        // Devolución de valores como estructura. Se excluye el nodo 0 y el servidor nCsma-1
+        res[k].nMediaIntentos     = observadores[k]->MediaIntentos (1, nCsma-2);
+        res[k].tMediaEco          = observadores[k]->MediaEco (1, nCsma-2);
+        res[k].porcenPaqTxCorrect = 100.0 - observadores[k]->PorcenPaqPerdidos (1, nCsma-2); // Correc % = 100 - Perdidos %
+        res[k].semilla            = RngSeedManager::GetSeed ();
+        res[k].run                = RngSeedManager::GetRun ();
+        res[k].segmento           = k;
+    }
+
+    return nEventos;
 }
\ No newline at end of file